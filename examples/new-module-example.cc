@@ -2,6 +2,7 @@
 #include "ns3/internet-module.h"
 #include "ns3/applications-module.h"
 #include "ns3/ipv4-drill-routing-protocol.h"
+#include "ns3/shared-buffer-helper.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/ipv4-global-routing-helper.h"
@@ -104,6 +105,12 @@ main(int argc, char* argv[])
     bool enableAscii = true;
     bool enableFlowMonitor = true;
     bool useDrill = true;  // Option to switch between DRILL and global routing
+    bool sharedBuffer = false;  // Share one buffer across the ports of each spine
+    std::string bufferSize = "200p";
+    double alpha = 1.0;
+    uint32_t nEngines = 1;  // Parallel forwarding engines per spine
+    bool engineHash = false;  // Dispatch to engines by flow hash instead of ingress port
+    Time engineCycle = Seconds(0);  // Queue snapshot interval shared by the engines
     
     CommandLine cmd;
     cmd.AddValue("d","DRILL d (#choices)", d);
@@ -113,6 +120,12 @@ main(int argc, char* argv[])
     cmd.AddValue("enableAscii","Enable ASCII tracing", enableAscii);
     cmd.AddValue("enableFlowMonitor","Enable FlowMonitor", enableFlowMonitor);
     cmd.AddValue("useDrill","Use DRILL routing (false = global routing)", useDrill);
+    cmd.AddValue("sharedBuffer","Use a shared buffer with dynamic thresholds on spines", sharedBuffer);
+    cmd.AddValue("bufferSize","Shared buffer size per spine", bufferSize);
+    cmd.AddValue("alpha","Dynamic threshold factor of each spine port", alpha);
+    cmd.AddValue("nEngines","DRILL forwarding engines per spine", nEngines);
+    cmd.AddValue("engineHash","Dispatch to engines by flow hash (false = ingress port)", engineHash);
+    cmd.AddValue("engineCycle","Queue snapshot interval of the engines (0 = live queues)", engineCycle);
     cmd.Parse(argc,argv);
 
     NodeContainer leaves, spines;
@@ -143,6 +156,15 @@ main(int argc, char* argv[])
         }
     }
     
+    if (sharedBuffer)
+    {
+        std::cout << "Installing shared buffers on spine switches..." << std::endl;
+        SharedBufferHelper sharedBufferHelper;
+        sharedBufferHelper.SetBufferAttribute("BufferSize", QueueSizeValue(QueueSize(bufferSize)));
+        sharedBufferHelper.SetQueueAttribute("Alpha", DoubleValue(alpha));
+        sharedBufferHelper.Install(spines);
+    }
+    
     if (useDrill)
     {
         // Install DRILL on spine switches (where load balancing decisions are made)
@@ -152,6 +174,14 @@ main(int argc, char* argv[])
             Ptr<Ipv4> ip = node->GetObject<Ipv4>();
             auto drill = CreateObject<Ipv4DrillRoutingProtocol>(d);
             drill->SetNextHops(spineIf[j]); // All interfaces to leaves
+            if (sharedBuffer)
+            {
+                drill->SetLoadMetric(Ipv4DrillRoutingProtocol::SHARED_BUFFER);
+            }
+            drill->SetEngines(nEngines,
+                              engineHash ? Ipv4DrillRoutingProtocol::FLOW_HASH
+                                         : Ipv4DrillRoutingProtocol::INGRESS_PORT);
+            drill->SetEngineSnapshotInterval(engineCycle);
             drill->SetIpv4(ip);
             ip->SetRoutingProtocol(drill);
             std::cout << "  Spine " << j << " has " << spineIf[j].size() << " next-hop interfaces" << std::endl;
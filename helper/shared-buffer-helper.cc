@@ -0,0 +1,76 @@
+#include "shared-buffer-helper.h"
+
+#include "ns3/log.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/queue-size.h"
+#include "ns3/shared-buffer-queue.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SharedBufferHelper");
+
+SharedBufferHelper::SharedBufferHelper()
+{
+    m_bufferFactory.SetTypeId("ns3::SharedBuffer");
+    m_queueFactory.SetTypeId("ns3::SharedBufferQueue");
+}
+
+void
+SharedBufferHelper::SetBufferAttribute(std::string name, const AttributeValue& value)
+{
+    m_bufferFactory.Set(name, value);
+}
+
+void
+SharedBufferHelper::SetQueueAttribute(std::string name, const AttributeValue& value)
+{
+    m_queueFactory.Set(name, value);
+}
+
+Ptr<SharedBuffer>
+SharedBufferHelper::Install(Ptr<Node> node) const
+{
+    NS_LOG_FUNCTION(this << node);
+    NS_ASSERT_MSG(!node->GetObject<SharedBuffer>(), "Node already has a shared buffer");
+
+    Ptr<SharedBuffer> buffer = m_bufferFactory.Create<SharedBuffer>();
+    node->AggregateObject(buffer);
+
+    for (uint32_t i = 0; i < node->GetNDevices(); ++i)
+    {
+        Ptr<PointToPointNetDevice> dev = DynamicCast<PointToPointNetDevice>(node->GetDevice(i));
+        if (!dev)
+        {
+            continue;
+        }
+        NS_ASSERT_MSG(dev->GetQueue()->IsEmpty(), "Cannot replace a non-empty device queue");
+
+        Ptr<SharedBufferQueue> queue = m_queueFactory.Create<SharedBufferQueue>();
+        // Only the shared buffer bounds the port
+        queue->SetMaxSize(buffer->GetBufferSize());
+        queue->SetSharedBuffer(buffer);
+        dev->SetQueue(queue);
+
+        // Keep flow control driven by the queue actually in use
+        Ptr<NetDeviceQueueInterface> ndqi = dev->GetObject<NetDeviceQueueInterface>();
+        if (ndqi)
+        {
+            ndqi->GetTxQueue(0)->ConnectQueueTraces<Queue<Packet>>(queue);
+        }
+        NS_LOG_INFO("Node " << node->GetId() << " device " << i << " uses the shared buffer");
+    }
+    return buffer;
+}
+
+void
+SharedBufferHelper::Install(NodeContainer nodes) const
+{
+    for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+    {
+        Install(*i);
+    }
+}
+
+} // namespace ns3
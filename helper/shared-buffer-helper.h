@@ -0,0 +1,59 @@
+#ifndef SHARED_BUFFER_HELPER_H
+#define SHARED_BUFFER_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/shared-buffer.h"
+
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * @brief Replace the port queues of a switch with SharedBufferQueues drawing
+ * from one SharedBuffer.
+ *
+ * Install() must run after the point-to-point devices have been created.
+ * The SharedBuffer is aggregated to the node so that other models can find it.
+ */
+class SharedBufferHelper
+{
+  public:
+    SharedBufferHelper();
+
+    /**
+     * @brief Set an attribute on each SharedBuffer created by Install().
+     * @param name the attribute name
+     * @param value the attribute value
+     */
+    void SetBufferAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * @brief Set an attribute on each SharedBufferQueue created by Install().
+     * @param name the attribute name
+     * @param value the attribute value
+     */
+    void SetQueueAttribute(std::string name, const AttributeValue& value);
+
+    /**
+     * @brief Install a shared buffer on every point-to-point device of a node.
+     * @param node the switch
+     * @return the buffer shared by the switch ports
+     */
+    Ptr<SharedBuffer> Install(Ptr<Node> node) const;
+
+    /**
+     * @brief Install a separate shared buffer on each node.
+     * @param nodes the switches
+     */
+    void Install(NodeContainer nodes) const;
+
+  private:
+    ObjectFactory m_bufferFactory;
+    ObjectFactory m_queueFactory;
+};
+
+} // namespace ns3
+
+#endif // SHARED_BUFFER_HELPER_H
@@ -0,0 +1,103 @@
+#include "alias-table.h"
+
+#include "ns3/assert.h"
+
+namespace ns3
+{
+
+void
+AliasTable::Build(const std::vector<double>& weights)
+{
+    uint32_t n = weights.size();
+    m_prob.assign(n, 0.0);
+    m_alias.assign(n, 0);
+    if (n == 0)
+    {
+        return;
+    }
+
+    double sum = 0.0;
+    for (auto w : weights)
+    {
+        NS_ASSERT_MSG(w >= 0.0, "Alias table weights must be non-negative");
+        sum += w;
+    }
+    NS_ASSERT_MSG(sum > 0.0, "Alias table needs at least one positive weight");
+
+    // Scale so that the average bucket holds exactly 1.0
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        scaled[i] = weights[i] * n / sum;
+        if (scaled[i] < 1.0)
+        {
+            small.push_back(i);
+        }
+        else
+        {
+            large.push_back(i);
+        }
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        uint32_t s = small.back();
+        small.pop_back();
+        uint32_t l = large.back();
+        m_prob[s] = scaled[s];
+        m_alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // Whatever is left is full up to rounding error
+    for (auto i : large)
+    {
+        m_prob[i] = 1.0;
+        m_alias[i] = i;
+    }
+    for (auto i : small)
+    {
+        m_prob[i] = 1.0;
+        m_alias[i] = i;
+    }
+}
+
+uint32_t
+AliasTable::Sample(std::mt19937& rng) const
+{
+    NS_ASSERT_MSG(!m_prob.empty(), "Sampling from an empty alias table");
+    std::uniform_int_distribution<uint32_t> bucket(0, m_prob.size() - 1);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    uint32_t i = bucket(rng);
+    return coin(rng) < m_prob[i] ? i : m_alias[i];
+}
+
+double
+AliasTable::GetProbability(uint32_t i) const
+{
+    NS_ASSERT(i < m_prob.size());
+    double p = m_prob[i];
+    for (uint32_t j = 0; j < m_prob.size(); ++j)
+    {
+        if (m_alias[j] == i && j != i)
+        {
+            p += 1.0 - m_prob[j];
+        }
+    }
+    return p / m_prob.size();
+}
+
+uint32_t
+AliasTable::GetN() const
+{
+    return m_prob.size();
+}
+
+} // namespace ns3
@@ -0,0 +1,54 @@
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * @brief Walker/Vose alias table for O(1) sampling from a discrete distribution.
+ *
+ * Build() is O(n) and must be called again whenever the weights change;
+ * Sample() costs one uniform integer and one uniform real draw.
+ */
+class AliasTable
+{
+  public:
+    AliasTable() = default;
+
+    /**
+     * @brief Rebuild the table from a set of non-negative weights.
+     * @param weights one weight per outcome; at least one must be positive
+     */
+    void Build(const std::vector<double>& weights);
+
+    /**
+     * @brief Draw an outcome index with probability proportional to its weight.
+     * @param rng the random engine to draw from
+     * @return the sampled index in [0, GetN())
+     */
+    uint32_t Sample(std::mt19937& rng) const;
+
+    /**
+     * @brief Get the probability of an outcome as encoded by the table.
+     * @param i the outcome index
+     * @return the probability of Sample() returning i
+     */
+    double GetProbability(uint32_t i) const;
+
+    /**
+     * @return the number of outcomes in the table
+     */
+    uint32_t GetN() const;
+
+  private:
+    std::vector<double> m_prob;
+    std::vector<uint32_t> m_alias;
+};
+
+} // namespace ns3
+
+#endif // ALIAS_TABLE_H
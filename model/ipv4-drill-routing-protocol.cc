@@ -1,7 +1,10 @@
 #include "ipv4-drill-routing-protocol.h"
 
+#include "shared-buffer-queue.h"
+
 #include "ns3/assert.h"
 #include "ns3/channel.h"
+#include "ns3/data-rate.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-interface-address.h"
@@ -11,7 +14,9 @@
 #include "ns3/packet.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/point-to-point-net-device.h"
+#include "ns3/ppp-header.h"
 #include "ns3/queue.h"
+#include "ns3/simulator.h"
 
 namespace ns3
 {
@@ -33,7 +38,8 @@ Ipv4DrillRoutingProtocol::Ipv4DrillRoutingProtocol(uint32_t d)
     : m_drill_d(d)
 {
     NS_LOG_FUNCTION(this << d);
-    m_rng = std::mt19937(std::random_device{}());
+    m_seeder = CreateObject<UniformRandomVariable>();
+    SetEngines(1, INGRESS_PORT);
 }
 
 Ipv4DrillRoutingProtocol::~Ipv4DrillRoutingProtocol()
@@ -74,53 +80,54 @@ Ipv4DrillRoutingProtocol::RouteInput(Ptr<const Packet> p,
     
     // For this simple demo, we'll use all next-hops
     // In a real implementation, we'd filter by reachability to destination
-    std::vector<uint32_t> validNextHops;
-    for(uint32_t i = 0; i < m_nextHops.size(); i++) {
-        validNextHops.push_back(i);
-    }
-    
-    // DRILL sampling: d random + m memory
+
+    // DRILL sampling: d weighted random + m memory, on this packet's engine
     std::vector<uint32_t> choices;
-    uint32_t N = validNextHops.size();
-    std::uniform_int_distribution<uint32_t> dist(0, N - 1);
+    uint32_t N = m_nextHops.size();
+    uint32_t e = SelectEngine(p, header, idev);
+    Engine& engine = m_engines[e];
     
     NS_LOG_DEBUG("DRILL routing for dest " << header.GetDestination() << 
-                " with " << N << " next-hops, d=" << m_drill_d);
+                " with " << N << " next-hops, d=" << m_drill_d << ", engine " << e);
     
     for (uint32_t i = 0; i < m_drill_d; ++i)
     {
-        uint32_t choice = validNextHops[dist(m_rng)];
+        uint32_t choice = m_sampler.Sample(engine.rng);
         choices.push_back(choice);
         NS_LOG_DEBUG("  Random choice " << i << ": next-hop " << choice);
     }
-    choices.insert(choices.end(), m_memory.begin(), m_memory.end());
+    choices.insert(choices.end(), engine.memory.begin(), engine.memory.end());
     
-    for (auto mem : m_memory)
+    for (auto mem : engine.memory)
     {
         NS_LOG_DEBUG("  Memory choice: next-hop " << mem);
     }
 
-    // pick best by smallest queue length
+    // pick best by lowest load relative to link weight
+    // Size as the device queue will account it, with the PPP header added
+    uint32_t bytes = p->GetSize() + header.GetSerializedSize() + PppHeader().GetSerializedSize();
+    if (m_snapshotInterval.IsStrictlyPositive() &&
+        (m_snapshot.size() != m_nextHops.size() ||
+         Simulator::Now() >= m_snapshotTime + m_snapshotInterval))
+    {
+        TakeSnapshot();
+    }
     uint32_t best = choices[0];
-    uint32_t minQ = std::numeric_limits<uint32_t>::max();
+    double minQ = std::numeric_limits<double>::max();
     for (auto idx : choices)
     {
-        Ptr<PointToPointNetDevice> dev = m_nextHops[idx]->GetObject<PointToPointNetDevice>();
-        Ptr<Queue<Packet>> q = dev->GetQueue();
-        uint32_t len = q->GetNPackets();
-        uint32_t maxSize = q->GetMaxSize().GetValue();
-        NS_LOG_DEBUG("  Next-hop " << idx << " queue length: " << len << "/" << maxSize);
-        if (len < minQ)
+        double load = GetNormalizedLoad(idx, bytes);
+        if (load < minQ)
         {
-            minQ = len;
+            minQ = load;
             best = idx;
         }
     }
     
-    NS_LOG_DEBUG("  Selected next-hop " << best << " with queue length " << minQ);
+    NS_LOG_DEBUG("  Selected next-hop " << best << " with normalized load " << minQ);
     
-    m_memory.clear();
-    m_memory.push_back(best);
+    engine.memory.clear();
+    engine.memory.push_back(best);
 
     // Build route
     Ptr<Ipv4Route> route = Create<Ipv4Route>();
@@ -200,8 +207,213 @@ Ipv4DrillRoutingProtocol::SetNextHops(const std::vector<Ptr<NetDevice>>& hops)
 {
     NS_LOG_FUNCTION(this << hops.size());
     m_nextHops = hops;
+    m_snapshot.clear();
+    for (auto& engine : m_engines)
+    {
+        engine.memory.clear();
+    }
+
+    NS_ASSERT_MSG(m_loadMetric != SHARED_BUFFER || AllNextHopsShared(),
+                  "SHARED_BUFFER needs a SharedBufferQueue on every next-hop");
+
+    // Default each weight to the link capacity
+    m_weights.clear();
+    RefreshWeights();
 };
 
+void
+Ipv4DrillRoutingProtocol::SetNextHopWeights(const std::vector<double>& weights)
+{
+    NS_LOG_FUNCTION(this << weights.size());
+    NS_ASSERT_MSG(weights.size() == m_nextHops.size(),
+                  "Expected one weight per next-hop");
+    for (auto w : weights)
+    {
+        NS_ASSERT_MSG(w > 0.0, "Next-hop weights must be positive");
+    }
+    m_weights = weights;
+    m_sampler.Build(m_weights);
+}
+
+void
+Ipv4DrillRoutingProtocol::RefreshWeights()
+{
+    NS_LOG_FUNCTION(this);
+    std::vector<double> weights;
+    for (const auto& hop : m_nextHops)
+    {
+        DataRateValue rate;
+        hop->GetAttribute("DataRate", rate);
+        weights.push_back(rate.Get().GetBitRate());
+    }
+    if (weights != m_weights)
+    {
+        NS_LOG_LOGIC("Next-hop rates changed, rebuilding the sampler");
+        m_weights = weights;
+        m_sampler.Build(m_weights);
+    }
+}
+
+void
+Ipv4DrillRoutingProtocol::SetLoadMetric(LoadMetric metric)
+{
+    NS_LOG_FUNCTION(this << metric);
+    m_loadMetric = metric;
+    NS_ASSERT_MSG(m_loadMetric != SHARED_BUFFER || AllNextHopsShared(),
+                  "SHARED_BUFFER needs a SharedBufferQueue on every next-hop");
+}
+
+bool
+Ipv4DrillRoutingProtocol::AllNextHopsShared() const
+{
+    for (const auto& hop : m_nextHops)
+    {
+        Ptr<PointToPointNetDevice> dev = hop->GetObject<PointToPointNetDevice>();
+        Ptr<SharedBufferQueue> sbq = DynamicCast<SharedBufferQueue>(dev->GetQueue());
+        if (!sbq || !sbq->GetSharedBuffer())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+Ipv4DrillRoutingProtocol::SetEngines(uint32_t n, EngineDispatch dispatch)
+{
+    NS_LOG_FUNCTION(this << n << dispatch);
+    NS_ASSERT_MSG(n > 0, "A switch needs at least one forwarding engine");
+    m_dispatch = dispatch;
+    m_engines.clear();
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t seed = m_seeder->GetInteger(0, std::numeric_limits<uint32_t>::max());
+        m_engines.push_back(Engine{{}, std::mt19937(seed)});
+    }
+}
+
+void
+Ipv4DrillRoutingProtocol::SetEngineSnapshotInterval(Time interval)
+{
+    NS_LOG_FUNCTION(this << interval);
+    m_snapshotInterval = interval;
+    m_snapshot.clear();
+}
+
+std::vector<uint32_t>
+Ipv4DrillRoutingProtocol::GetEngineMemory(uint32_t engine) const
+{
+    NS_ASSERT(engine < m_engines.size());
+    return m_engines[engine].memory;
+}
+
+int64_t
+Ipv4DrillRoutingProtocol::AssignStreams(int64_t stream)
+{
+    NS_LOG_FUNCTION(this << stream);
+    m_seeder->SetStream(stream);
+    for (auto& engine : m_engines)
+    {
+        engine.rng.seed(m_seeder->GetInteger(0, std::numeric_limits<uint32_t>::max()));
+    }
+    return 1;
+}
+
+uint32_t
+Ipv4DrillRoutingProtocol::SelectEngine(Ptr<const Packet> p,
+                                       const Ipv4Header& header,
+                                       Ptr<const NetDevice> idev) const
+{
+    uint32_t n = m_engines.size();
+    if (n == 1)
+    {
+        return 0;
+    }
+
+    if (m_dispatch == INGRESS_PORT)
+    {
+        int32_t interface = m_ipv4->GetInterfaceForDevice(idev);
+        return interface < 0 ? 0 : interface % n;
+    }
+
+    // FNV-1a over the 5-tuple; ports are the first 4 bytes of TCP and UDP
+    uint8_t key[13] = {};
+    header.GetSource().Serialize(key);
+    header.GetDestination().Serialize(key + 4);
+    key[8] = header.GetProtocol();
+    if ((header.GetProtocol() == 6 || header.GetProtocol() == 17) &&
+        header.GetFragmentOffset() == 0 && p->GetSize() >= 4)
+    {
+        p->CopyData(key + 9, 4);
+    }
+    uint32_t hash = 2166136261u;
+    for (auto byte : key)
+    {
+        hash = (hash ^ byte) * 16777619u;
+    }
+    return hash % n;
+}
+
+Ipv4DrillRoutingProtocol::QueueState
+Ipv4DrillRoutingProtocol::ReadQueueState(uint32_t idx) const
+{
+    Ptr<PointToPointNetDevice> dev = m_nextHops[idx]->GetObject<PointToPointNetDevice>();
+    Ptr<Queue<Packet>> q = dev->GetQueue();
+    QueueState state{q->GetNPackets(), false, false, 0, 0.0};
+
+    Ptr<SharedBufferQueue> sbq = DynamicCast<SharedBufferQueue>(q);
+    if (sbq && sbq->GetSharedBuffer())
+    {
+        Ptr<SharedBuffer> buffer = sbq->GetSharedBuffer();
+        state.shared = true;
+        state.byteMode = buffer->GetBufferSize().GetUnit() == QueueSizeUnit::BYTES;
+        state.occupancy = sbq->GetOccupancy();
+        state.threshold = buffer->GetThreshold(sbq->GetAlpha());
+    }
+    return state;
+}
+
+void
+Ipv4DrillRoutingProtocol::TakeSnapshot()
+{
+    NS_LOG_FUNCTION(this);
+    m_snapshot.clear();
+    for (uint32_t idx = 0; idx < m_nextHops.size(); ++idx)
+    {
+        m_snapshot.push_back(ReadQueueState(idx));
+    }
+    m_snapshotTime = Simulator::Now();
+}
+
+double
+Ipv4DrillRoutingProtocol::GetNormalizedLoad(uint32_t idx, uint32_t bytes) const
+{
+    QueueState state =
+        m_snapshotInterval.IsStrictlyPositive() ? m_snapshot[idx] : ReadQueueState(idx);
+
+    if (m_loadMetric == SHARED_BUFFER)
+    {
+        NS_ASSERT(state.shared);
+        // A port with no room left under its threshold would drop the packet
+        if (state.threshold <= 0.0)
+        {
+            return std::numeric_limits<double>::max();
+        }
+        double share = (state.occupancy + (state.byteMode ? bytes : 1)) / state.threshold;
+        double load = share / m_weights[idx];
+        NS_LOG_DEBUG("  Next-hop " << idx << " queue length: " << state.packets
+                                   << ", threshold share " << share << ", weight "
+                                   << m_weights[idx] << ", load " << load);
+        return load;
+    }
+
+    // Count the packet being routed so that idle links still rank by weight
+    double load = (state.packets + 1) / m_weights[idx];
+    NS_LOG_DEBUG("  Next-hop " << idx << " queue length: " << state.packets << ", weight "
+                               << m_weights[idx] << ", load " << load);
+    return load;
+}
+
 void
 Ipv4DrillRoutingProtocol::NotifyInterfaceUp (uint32_t interface) {
     NS_LOG_FUNCTION(this << interface);
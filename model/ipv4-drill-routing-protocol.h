@@ -1,7 +1,11 @@
 #ifndef IPV4_DRILL_ROUTING_PROTOCOL_H
 #define IPV4_DRILL_ROUTING_PROTOCOL_H
 
+#include "alias-table.h"
+
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
 
 #include <random>
 
@@ -11,6 +15,20 @@ namespace ns3
 class Ipv4DrillRoutingProtocol : public Ipv4RoutingProtocol
 {
   public:
+    /// Queue state compared between sampled next-hops
+    enum LoadMetric
+    {
+        QUEUE_PACKETS, //!< Packets in the device queue
+        SHARED_BUFFER, //!< Port headroom under the SharedBuffer dynamic threshold
+    };
+
+    /// How packets are spread over the forwarding engines of a switch
+    enum EngineDispatch
+    {
+        INGRESS_PORT, //!< Engine chosen by the ingress interface
+        FLOW_HASH,    //!< Engine chosen by a hash of the 5-tuple
+    };
+
     /**
      * @brief Get the type ID.
      * @return the object TypeId
@@ -41,12 +59,152 @@ class Ipv4DrillRoutingProtocol : public Ipv4RoutingProtocol
     void PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override;
     void SetNextHops(const std::vector<Ptr<NetDevice>>& hops);
 
+    /**
+     * @brief Override the sampling weight of each next-hop.
+     *
+     * SetNextHops() defaults every weight to the device's DataRate. Weights
+     * set here replace those until SetNextHops() or RefreshWeights() is
+     * called. Queue lengths are divided by the same weights before being
+     * compared.
+     *
+     * @param weights one positive weight per next-hop, in SetNextHops() order
+     */
+    void SetNextHopWeights(const std::vector<double>& weights);
+
+    /**
+     * @brief Reload the weights from the next-hop DataRates.
+     *
+     * DataRates are not read while routing. Call this after changing the
+     * rate of a next-hop, e.g. to degrade a bundle member. The sampler is
+     * rebuilt only if a weight actually changed.
+     */
+    void RefreshWeights();
+
+    /**
+     * @brief Select the queue state DRILL compares next-hops by.
+     *
+     * SHARED_BUFFER ranks a port by the share of its dynamic threshold,
+     * alpha * (free buffer), it would use after taking the packet being
+     * routed, divided by the next-hop weight like QUEUE_PACKETS. A faster
+     * port can therefore win while closer to its threshold, since it drains
+     * sooner. Every next-hop must use a SharedBufferQueue attached to a
+     * SharedBuffer.
+     *
+     * @param metric the load metric
+     */
+    void SetLoadMetric(LoadMetric metric);
+
+    /**
+     * @brief Model several forwarding engines running DRILL on one switch.
+     *
+     * Each engine keeps private memory and random state; the sampler and the
+     * device queues are shared. Decisions are still made one packet at a
+     * time, so by default an engine sees the enqueues of the engine before
+     * it. See SetEngineSnapshotInterval() to make engines decide on the same
+     * stale queue state instead. Resets the memory of all engines.
+     *
+     * @param n the number of engines, at least 1
+     * @param dispatch how packets are assigned to engines
+     */
+    void SetEngines(uint32_t n, EngineDispatch dispatch);
+
+    /**
+     * @brief Make all engines read a queue snapshot taken once per interval.
+     *
+     * Decisions falling within the same interval compare the same queue
+     * state, as concurrent pipelines reading at the same cycle would, which
+     * exposes herding onto the same next-hop. Zero, the default, reads the
+     * live queues on every decision.
+     *
+     * @param interval the snapshot refresh interval
+     */
+    void SetEngineSnapshotInterval(Time interval);
+
+    /**
+     * @brief Pick the forwarding engine that handles a packet.
+     * @param p the packet, without its IPv4 header
+     * @param header the IPv4 header
+     * @param idev the ingress device
+     * @return the engine index
+     */
+    uint32_t SelectEngine(Ptr<const Packet> p,
+                          const Ipv4Header& header,
+                          Ptr<const NetDevice> idev) const;
+
+    /**
+     * @brief Get the next-hops an engine remembers from its last decision.
+     * @param engine the engine index
+     * @return the remembered next-hop indices
+     */
+    std::vector<uint32_t> GetEngineMemory(uint32_t engine) const;
+
+    /**
+     * @brief Assign a fixed random variable stream number to the engine seeds.
+     *
+     * Engines are seeded from an ns-3 random variable, so runs repeat for a
+     * given seed and run number. This reseeds every engine from the stream.
+     *
+     * @param stream first stream index to use
+     * @return the number of stream indices assigned by this model
+     */
+    int64_t AssignStreams(int64_t stream);
+
   private:
+    /// Private DRILL state of one forwarding engine
+    struct Engine
+    {
+        std::vector<uint32_t> memory; //!< Best next-hops remembered from last decision
+        std::mt19937 rng;             //!< Sampling random state
+    };
+
+    /// Queue state of a next-hop as compared by the engines
+    struct QueueState
+    {
+        uint32_t packets;  //!< Packets in the device queue
+        bool shared;       //!< Whether the queue draws from a SharedBuffer
+        bool byteMode;     //!< Whether the SharedBuffer is sized in bytes
+        uint32_t occupancy; //!< Port occupancy, in buffer units
+        double threshold;   //!< Dynamic threshold of the port, in buffer units
+    };
+
+    /**
+     * @brief Read the current queue state of a next-hop.
+     * @param idx the next-hop index
+     * @return the queue state
+     */
+    QueueState ReadQueueState(uint32_t idx) const;
+
+    /**
+     * @brief Store the current queue state of every next-hop.
+     */
+    void TakeSnapshot();
+
+    /**
+     * @brief Check that every next-hop queue draws from a SharedBuffer.
+     * @return true if SHARED_BUFFER can rank all next-hops
+     */
+    bool AllNextHopsShared() const;
+
+    /**
+     * @brief Get the load of a next-hop, normalized by its weight.
+     * @param idx the next-hop index
+     * @param bytes the size the packet being routed will take in the device queue
+     * @return the load, lower is better
+     */
+    double GetNormalizedLoad(uint32_t idx, uint32_t bytes) const;
+
     uint32_t m_drill_d = 2;
-    std::vector<uint32_t> m_memory;
+    LoadMetric m_loadMetric = QUEUE_PACKETS;
+    EngineDispatch m_dispatch = INGRESS_PORT;
+    std::vector<Engine> m_engines;
+    Ptr<UniformRandomVariable> m_seeder;
+    Time m_snapshotInterval;
+    Time m_snapshotTime;
+    std::vector<QueueState> m_snapshot;
     std::vector<Ptr<NetDevice>> m_nextHops;
+    std::vector<double> m_weights;
+    AliasTable m_sampler;
     Ptr<Ipv4> m_ipv4;
-    std::mt19937 m_rng;
 };
 
 } // namespace ns3
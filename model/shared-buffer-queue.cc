@@ -0,0 +1,156 @@
+#include "shared-buffer-queue.h"
+
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SharedBufferQueue");
+
+NS_OBJECT_ENSURE_REGISTERED(SharedBufferQueue);
+
+TypeId
+SharedBufferQueue::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SharedBufferQueue")
+            .SetParent<Queue<Packet>>()
+            .SetGroupName("LoadBalancing")
+            .AddConstructor<SharedBufferQueue>()
+            .AddAttribute("Alpha",
+                          "Dynamic threshold factor of this port",
+                          DoubleValue(1.0),
+                          MakeDoubleAccessor(&SharedBufferQueue::m_alpha),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("SharedBuffer",
+                          "The switch buffer this port draws from",
+                          PointerValue(),
+                          MakePointerAccessor(&SharedBufferQueue::m_buffer),
+                          MakePointerChecker<SharedBuffer>());
+    return tid;
+}
+
+SharedBufferQueue::SharedBufferQueue()
+    : m_alpha(1.0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SharedBufferQueue::~SharedBufferQueue()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+bool
+SharedBufferQueue::Enqueue(Ptr<Packet> item)
+{
+    NS_LOG_FUNCTION(this << item);
+
+    uint32_t size = GetItemSize(item->GetSize());
+    if (m_buffer && !m_buffer->Admit(GetOccupancy(), size, m_alpha))
+    {
+        DropBeforeEnqueue(item);
+        return false;
+    }
+
+    // DoEnqueue drops the item itself if it exceeds MaxSize
+    if (!DoEnqueue(GetContainer().end(), item))
+    {
+        return false;
+    }
+    if (m_buffer)
+    {
+        m_buffer->Reserve(size);
+    }
+    return true;
+}
+
+Ptr<Packet>
+SharedBufferQueue::Dequeue()
+{
+    NS_LOG_FUNCTION(this);
+
+    Ptr<Packet> item = DoDequeue(GetContainer().begin());
+    if (item && m_buffer)
+    {
+        m_buffer->Release(GetItemSize(item->GetSize()));
+    }
+    return item;
+}
+
+Ptr<Packet>
+SharedBufferQueue::Remove()
+{
+    NS_LOG_FUNCTION(this);
+
+    Ptr<Packet> item = DoRemove(GetContainer().begin());
+    if (item && m_buffer)
+    {
+        m_buffer->Release(GetItemSize(item->GetSize()));
+    }
+    return item;
+}
+
+Ptr<const Packet>
+SharedBufferQueue::Peek() const
+{
+    NS_LOG_FUNCTION(this);
+
+    return DoPeek(GetContainer().begin());
+}
+
+void
+SharedBufferQueue::SetSharedBuffer(Ptr<SharedBuffer> buffer)
+{
+    NS_LOG_FUNCTION(this << buffer);
+    NS_ASSERT_MSG(IsEmpty(), "Cannot change the shared buffer of a non-empty queue");
+    m_buffer = buffer;
+}
+
+Ptr<SharedBuffer>
+SharedBufferQueue::GetSharedBuffer() const
+{
+    return m_buffer;
+}
+
+double
+SharedBufferQueue::GetAlpha() const
+{
+    return m_alpha;
+}
+
+uint32_t
+SharedBufferQueue::GetOccupancy() const
+{
+    if (m_buffer && m_buffer->GetBufferSize().GetUnit() == QueueSizeUnit::BYTES)
+    {
+        return GetNBytes();
+    }
+    return GetNPackets();
+}
+
+uint32_t
+SharedBufferQueue::GetItemSize(uint32_t bytes) const
+{
+    if (m_buffer && m_buffer->GetBufferSize().GetUnit() == QueueSizeUnit::BYTES)
+    {
+        return bytes;
+    }
+    return 1;
+}
+
+void
+SharedBufferQueue::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_buffer)
+    {
+        m_buffer->Release(GetOccupancy());
+        m_buffer = nullptr;
+    }
+    Queue<Packet>::DoDispose();
+}
+
+} // namespace ns3
@@ -0,0 +1,74 @@
+#ifndef SHARED_BUFFER_QUEUE_H
+#define SHARED_BUFFER_QUEUE_H
+
+#include "shared-buffer.h"
+
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+
+namespace ns3
+{
+
+/**
+ * @brief FIFO port queue that draws its space from a switch-wide SharedBuffer.
+ *
+ * Packets are admitted only if the SharedBuffer dynamic threshold allows it
+ * for this port's Alpha. Without a SharedBuffer the queue behaves like a
+ * DropTailQueue bounded by MaxSize.
+ */
+class SharedBufferQueue : public Queue<Packet>
+{
+  public:
+    /**
+     * @brief Get the type ID.
+     * @return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SharedBufferQueue();
+    ~SharedBufferQueue() override;
+
+    bool Enqueue(Ptr<Packet> item) override;
+    Ptr<Packet> Dequeue() override;
+    Ptr<Packet> Remove() override;
+    Ptr<const Packet> Peek() const override;
+
+    /**
+     * @brief Attach the queue to a switch buffer.
+     * @param buffer the buffer shared with the other ports of the switch
+     */
+    void SetSharedBuffer(Ptr<SharedBuffer> buffer);
+
+    /**
+     * @return the buffer this queue draws from, or nullptr
+     */
+    Ptr<SharedBuffer> GetSharedBuffer() const;
+
+    /**
+     * @return the dynamic threshold factor of this port
+     */
+    double GetAlpha() const;
+
+    /**
+     * @return what this port holds in the units of the shared buffer
+     */
+    uint32_t GetOccupancy() const;
+
+    /**
+     * @brief Get the size an item takes in the shared buffer.
+     * @param bytes the size of the item in bytes
+     * @return 1 for a buffer sized in packets, bytes otherwise
+     */
+    uint32_t GetItemSize(uint32_t bytes) const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    Ptr<SharedBuffer> m_buffer;
+    double m_alpha;
+};
+
+} // namespace ns3
+
+#endif // SHARED_BUFFER_QUEUE_H
@@ -0,0 +1,98 @@
+#include "shared-buffer.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/trace-source-accessor.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SharedBuffer");
+
+NS_OBJECT_ENSURE_REGISTERED(SharedBuffer);
+
+TypeId
+SharedBuffer::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::SharedBuffer")
+            .SetParent<Object>()
+            .SetGroupName("LoadBalancing")
+            .AddConstructor<SharedBuffer>()
+            .AddAttribute("BufferSize",
+                          "The size of the buffer shared by all ports of the switch",
+                          QueueSizeValue(QueueSize("500p")),
+                          MakeQueueSizeAccessor(&SharedBuffer::m_bufferSize),
+                          MakeQueueSizeChecker())
+            .AddTraceSource("Occupancy",
+                            "Buffer space in use across all ports",
+                            MakeTraceSourceAccessor(&SharedBuffer::m_occupancy),
+                            "ns3::TracedValueCallback::Uint32");
+    return tid;
+}
+
+SharedBuffer::SharedBuffer()
+    : m_occupancy(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+SharedBuffer::~SharedBuffer()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+bool
+SharedBuffer::Admit(uint32_t portOccupancy, uint32_t size, double alpha) const
+{
+    NS_LOG_FUNCTION(this << portOccupancy << size << alpha);
+
+    if (m_occupancy + size > m_bufferSize.GetValue())
+    {
+        NS_LOG_LOGIC("Buffer full: " << m_occupancy << "/" << m_bufferSize);
+        return false;
+    }
+    double threshold = GetThreshold(alpha);
+    if (portOccupancy >= threshold)
+    {
+        NS_LOG_LOGIC("Port over dynamic threshold: " << portOccupancy << " >= " << threshold);
+        return false;
+    }
+    return true;
+}
+
+double
+SharedBuffer::GetThreshold(double alpha) const
+{
+    return alpha * (m_bufferSize.GetValue() - m_occupancy);
+}
+
+void
+SharedBuffer::Reserve(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    NS_ASSERT(m_occupancy + size <= m_bufferSize.GetValue());
+    m_occupancy += size;
+}
+
+void
+SharedBuffer::Release(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    NS_ASSERT(m_occupancy >= size);
+    m_occupancy -= size;
+}
+
+uint32_t
+SharedBuffer::GetOccupancy() const
+{
+    return m_occupancy;
+}
+
+QueueSize
+SharedBuffer::GetBufferSize() const
+{
+    return m_bufferSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,75 @@
+#ifndef SHARED_BUFFER_H
+#define SHARED_BUFFER_H
+
+#include "ns3/object.h"
+#include "ns3/queue-size.h"
+#include "ns3/traced-value.h"
+
+namespace ns3
+{
+
+/**
+ * @brief Packet buffer shared by all the ports of one switch.
+ *
+ * Each SharedBufferQueue attached to the buffer asks it for admission and
+ * reports what it holds. A port is admitted with the dynamic threshold rule:
+ * its occupancy must stay below alpha times the free buffer space.
+ */
+class SharedBuffer : public Object
+{
+  public:
+    /**
+     * @brief Get the type ID.
+     * @return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    SharedBuffer();
+    ~SharedBuffer() override;
+
+    /**
+     * @brief Check whether a port may enqueue an item.
+     * @param portOccupancy what the port already holds, in buffer units
+     * @param size the size of the item, in buffer units
+     * @param alpha the dynamic threshold factor of the port
+     * @return true if the item fits under the port threshold and the buffer
+     */
+    bool Admit(uint32_t portOccupancy, uint32_t size, double alpha) const;
+
+    /**
+     * @brief Get the current dynamic threshold of a port.
+     * @param alpha the dynamic threshold factor of the port
+     * @return alpha times the free buffer space, in buffer units
+     */
+    double GetThreshold(double alpha) const;
+
+    /**
+     * @brief Account for an item entering one of the ports.
+     * @param size the size of the item, in buffer units
+     */
+    void Reserve(uint32_t size);
+
+    /**
+     * @brief Account for an item leaving one of the ports.
+     * @param size the size of the item, in buffer units
+     */
+    void Release(uint32_t size);
+
+    /**
+     * @return the buffer space in use, in buffer units
+     */
+    uint32_t GetOccupancy() const;
+
+    /**
+     * @return the total buffer size
+     */
+    QueueSize GetBufferSize() const;
+
+  private:
+    QueueSize m_bufferSize;
+    TracedValue<uint32_t> m_occupancy;
+};
+
+} // namespace ns3
+
+#endif // SHARED_BUFFER_H
@@ -1,5 +1,20 @@
 // Include a header file from your module to test.
+#include "ns3/alias-table.h"
 #include "ns3/ipv4-drill-routing-protocol.h"
+#include "ns3/shared-buffer-helper.h"
+#include "ns3/shared-buffer-queue.h"
+
+#include "ns3/data-rate.h"
+#include "ns3/double.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-generator.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <set>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -56,6 +71,654 @@ NewModuleTestCase1::DoRun()
     NS_TEST_ASSERT_MSG_EQ_TOL(0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * @ingroup new-module-tests
+ * Check that the alias table samples next-hops in proportion to their weights
+ */
+class AliasTableTestCase : public TestCase
+{
+  public:
+    AliasTableTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+AliasTableTestCase::AliasTableTestCase()
+    : TestCase("Alias table samples proportionally to weights")
+{
+}
+
+void
+AliasTableTestCase::DoRun()
+{
+    // Two 40G and two 100G spine links, plus a fifth link down to 0 weight
+    std::vector<double> weights = {40e9, 100e9, 100e9, 40e9, 0.0};
+    AliasTable table;
+    table.Build(weights);
+    NS_TEST_ASSERT_MSG_EQ(table.GetN(), weights.size(), "Wrong table size");
+
+    double sum = 280e9;
+    for (uint32_t i = 0; i < weights.size(); ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ_TOL(table.GetProbability(i),
+                                  weights[i] / sum,
+                                  1e-9,
+                                  "Encoded probability does not match weight " << i);
+    }
+
+    std::mt19937 rng(1);
+    std::vector<uint32_t> counts(weights.size(), 0);
+    const uint32_t draws = 100000;
+    for (uint32_t i = 0; i < draws; ++i)
+    {
+        counts[table.Sample(rng)]++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(counts[4], 0u, "Zero-weight entry was sampled");
+    for (uint32_t i = 0; i < weights.size(); ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ_TOL(static_cast<double>(counts[i]) / draws,
+                                  weights[i] / sum,
+                                  0.01,
+                                  "Sampled frequency does not match weight " << i);
+    }
+}
+
+/**
+ * @ingroup new-module-tests
+ * Base for test cases that route packets through a DRILL switch
+ */
+class DrillTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     * @param name the test case name
+     */
+    DrillTestCase(std::string name);
+
+  protected:
+    /**
+     * Build a switch with one point-to-point link to a neighbour per rate
+     * @param rates the DataRate of each link
+     * @return the switch side devices, in the order of rates
+     */
+    NetDeviceContainer BuildSwitch(const std::vector<std::string>& rates);
+
+    /**
+     * Route a packet through DRILL
+     * @param drill the routing protocol of the switch
+     * @param p the packet, without its IPv4 header
+     * @param header the IPv4 header
+     * @param idev the ingress device
+     * @return the output device DRILL picked, or nullptr
+     */
+    Ptr<NetDevice> Route(Ptr<Ipv4DrillRoutingProtocol> drill,
+                         Ptr<const Packet> p,
+                         const Ipv4Header& header,
+                         Ptr<const NetDevice> idev);
+
+    /**
+     * Put packets in the queue of a device
+     * @param dev the device
+     * @param n the number of 100 byte packets
+     */
+    void Fill(Ptr<NetDevice> dev, uint32_t n);
+
+    Ptr<Node> m_switch; //!< The switch built by BuildSwitch()
+
+  private:
+    /**
+     * Unicast forward callback recording the output device
+     * @param route the route DRILL built
+     * @param p the packet
+     * @param header the IPv4 header
+     */
+    void Forward(Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header& header);
+
+    Ptr<NetDevice> m_outDev; //!< Output device of the last routed packet
+};
+
+DrillTestCase::DrillTestCase(std::string name)
+    : TestCase(name)
+{
+}
+
+NetDeviceContainer
+DrillTestCase::BuildSwitch(const std::vector<std::string>& rates)
+{
+    Ipv4AddressGenerator::Reset();
+    m_switch = CreateObject<Node>();
+    NodeContainer neighbours;
+    neighbours.Create(rates.size());
+    InternetStackHelper internet;
+    internet.Install(m_switch);
+    internet.Install(neighbours);
+
+    PointToPointHelper p2p;
+    Ipv4AddressHelper ipv4;
+    NetDeviceContainer hops;
+    for (uint32_t i = 0; i < rates.size(); ++i)
+    {
+        p2p.SetDeviceAttribute("DataRate", StringValue(rates[i]));
+        NetDeviceContainer devs = p2p.Install(m_switch, neighbours.Get(i));
+        std::ostringstream base;
+        base << "10.0." << i << ".0";
+        ipv4.SetBase(base.str().c_str(), "255.255.255.0");
+        ipv4.Assign(devs);
+        hops.Add(devs.Get(0));
+    }
+    return hops;
+}
+
+Ptr<NetDevice>
+DrillTestCase::Route(Ptr<Ipv4DrillRoutingProtocol> drill,
+                     Ptr<const Packet> p,
+                     const Ipv4Header& header,
+                     Ptr<const NetDevice> idev)
+{
+    m_outDev = nullptr;
+    drill->RouteInput(p,
+                      header,
+                      idev,
+                      MakeCallback(&DrillTestCase::Forward, this),
+                      Ipv4RoutingProtocol::MulticastForwardCallback(),
+                      Ipv4RoutingProtocol::LocalDeliverCallback(),
+                      Ipv4RoutingProtocol::ErrorCallback());
+    return m_outDev;
+}
+
+void
+DrillTestCase::Fill(Ptr<NetDevice> dev, uint32_t n)
+{
+    Ptr<Queue<Packet>> q = DynamicCast<PointToPointNetDevice>(dev)->GetQueue();
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        q->Enqueue(Create<Packet>(100));
+    }
+}
+
+void
+DrillTestCase::Forward(Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header& header)
+{
+    m_outDev = route->GetOutputDevice();
+}
+
+/**
+ * @ingroup new-module-tests
+ * Check that DRILL compares next-hops by load normalized to link rate
+ */
+class DrillRateWeightingTestCase : public DrillTestCase
+{
+  public:
+    DrillRateWeightingTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DrillRateWeightingTestCase::DrillRateWeightingTestCase()
+    : DrillTestCase("DRILL prefers faster links at equal queue length")
+{
+}
+
+void
+DrillRateWeightingTestCase::DoRun()
+{
+    NetDeviceContainer hops = BuildSwitch({"40Mbps", "100Mbps"});
+    Fill(hops.Get(0), 3);
+    Fill(hops.Get(1), 3);
+
+    // A large d makes sure both links are sampled on every decision
+    Ptr<Ipv4DrillRoutingProtocol> drill = CreateObject<Ipv4DrillRoutingProtocol>(16);
+    drill->SetIpv4(m_switch->GetObject<Ipv4>());
+    drill->SetNextHops(std::vector<Ptr<NetDevice>>(hops.Begin(), hops.End()));
+
+    Ipv4Header header;
+    header.SetSource(Ipv4Address("10.0.0.2"));
+    header.SetDestination(Ipv4Address("10.9.9.9"));
+
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(1),
+                          "Equal queues should favour the 100Mbps link");
+
+    // Rates are not re-read while routing
+    hops.Get(1)->SetAttribute("DataRate", DataRateValue(DataRate("10Mbps")));
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(1),
+                          "The rate change should wait for RefreshWeights()");
+
+    // Refreshing picks up the degraded link
+    drill->RefreshWeights();
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(0),
+                          "The degraded link should lose to the 40Mbps one");
+
+    // Explicit weights override the link rates
+    drill->SetNextHopWeights({1.0, 100.0});
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(1),
+                          "SetNextHopWeights should change the pick");
+
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup new-module-tests
+ * Check dynamic threshold admission and accounting of a shared buffer
+ */
+class SharedBufferQueueTestCase : public TestCase
+{
+  public:
+    SharedBufferQueueTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SharedBufferQueueTestCase::SharedBufferQueueTestCase()
+    : TestCase("Shared buffer admits ports by dynamic threshold")
+{
+}
+
+void
+SharedBufferQueueTestCase::DoRun()
+{
+    Ptr<SharedBuffer> buffer = CreateObject<SharedBuffer>();
+    buffer->SetAttribute("BufferSize", QueueSizeValue(QueueSize("10p")));
+
+    Ptr<SharedBufferQueue> q1 = CreateObject<SharedBufferQueue>();
+    Ptr<SharedBufferQueue> q2 = CreateObject<SharedBufferQueue>();
+    for (auto q : {q1, q2})
+    {
+        q->SetMaxSize(QueueSize("10p"));
+        q->SetSharedBuffer(buffer);
+    }
+
+    // With alpha = 1 a lone port stops at half of the buffer
+    uint32_t admitted = 0;
+    while (q1->Enqueue(Create<Packet>(100)))
+    {
+        admitted++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(admitted, 5u, "Lone port should get B / 2");
+
+    // The second port sees only what the first one left free
+    admitted = 0;
+    while (q2->Enqueue(Create<Packet>(100)))
+    {
+        admitted++;
+    }
+    NS_TEST_ASSERT_MSG_EQ(admitted, 3u, "Second port should stop at alpha * free space");
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetOccupancy(), 8u, "Buffer accounting is off");
+
+    q1->Dequeue();
+    q1->Remove();
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetOccupancy(), 6u, "Dequeue did not release the buffer");
+    NS_TEST_ASSERT_MSG_EQ(q2->Enqueue(Create<Packet>(100)), true, "Released space not reused");
+
+    q1->Dispose();
+    q2->Dispose();
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetOccupancy(), 0u, "Disposed queues still hold the buffer");
+}
+
+/**
+ * @ingroup new-module-tests
+ * Check dynamic threshold admission and accounting of a buffer sized in bytes
+ */
+class SharedBufferQueueBytesTestCase : public TestCase
+{
+  public:
+    SharedBufferQueueBytesTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+SharedBufferQueueBytesTestCase::SharedBufferQueueBytesTestCase()
+    : TestCase("Shared buffer sized in bytes charges packet sizes")
+{
+}
+
+void
+SharedBufferQueueBytesTestCase::DoRun()
+{
+    Ptr<SharedBuffer> buffer = CreateObject<SharedBuffer>();
+    buffer->SetAttribute("BufferSize", QueueSizeValue(QueueSize("1000B")));
+
+    Ptr<SharedBufferQueue> q1 = CreateObject<SharedBufferQueue>();
+    Ptr<SharedBufferQueue> q2 = CreateObject<SharedBufferQueue>();
+    for (auto q : {q1, q2})
+    {
+        q->SetMaxSize(QueueSize("1000B"));
+        q->SetSharedBuffer(buffer);
+    }
+
+    // Port 1 is admitted while below 1000 - its own occupancy, i.e. 500B
+    uint32_t admitted = 0;
+    for (uint32_t size : {200, 300, 100, 250})
+    {
+        admitted += q1->Enqueue(Create<Packet>(size));
+    }
+    NS_TEST_ASSERT_MSG_EQ(admitted, 2u, "Port 1 should stop once it holds 500B");
+    NS_TEST_ASSERT_MSG_EQ(q1->GetOccupancy(), 500u, "Port 1 should hold 200B + 300B");
+
+    // Port 2 stops once at or above 1000 - 500 - its own occupancy
+    admitted = 0;
+    for (uint32_t size : {150, 150, 150})
+    {
+        admitted += q2->Enqueue(Create<Packet>(size));
+    }
+    NS_TEST_ASSERT_MSG_EQ(admitted, 2u, "Port 2 should stop at alpha * free space");
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetOccupancy(), 800u, "Buffer accounting is off");
+
+    q1->Dequeue();
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetOccupancy(), 600u, "Dequeue did not release 200B");
+    q1->Remove();
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetOccupancy(), 300u, "Remove did not release 300B");
+    NS_TEST_ASSERT_MSG_EQ(q1->GetOccupancy(), 0u, "Port 1 should be empty");
+
+    // Under the threshold but larger than the free buffer
+    NS_TEST_ASSERT_MSG_EQ(q1->Enqueue(Create<Packet>(800)),
+                          false,
+                          "A packet larger than the free buffer was admitted");
+
+    q1->Dispose();
+    q2->Dispose();
+    NS_TEST_ASSERT_MSG_EQ(buffer->GetOccupancy(), 0u, "Disposed queues still hold the buffer");
+}
+
+/**
+ * @ingroup new-module-tests
+ * Check that the SHARED_BUFFER metric ranks ports by dynamic threshold headroom
+ */
+class DrillSharedBufferTestCase : public DrillTestCase
+{
+  public:
+    DrillSharedBufferTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DrillSharedBufferTestCase::DrillSharedBufferTestCase()
+    : DrillTestCase("DRILL reads shared buffer headroom")
+{
+}
+
+void
+DrillSharedBufferTestCase::DoRun()
+{
+    NetDeviceContainer hops = BuildSwitch({"100Mbps", "100Mbps"});
+    SharedBufferHelper sharedBufferHelper;
+    sharedBufferHelper.SetBufferAttribute("BufferSize", QueueSizeValue(QueueSize("100p")));
+    sharedBufferHelper.Install(m_switch);
+
+    // Port 0 holds more packets but has a much higher threshold than port 1
+    auto queue = [&hops](uint32_t i) {
+        return DynamicCast<SharedBufferQueue>(
+            DynamicCast<PointToPointNetDevice>(hops.Get(i))->GetQueue());
+    };
+    queue(0)->SetAttribute("Alpha", DoubleValue(2.0));
+    queue(1)->SetAttribute("Alpha", DoubleValue(0.5));
+    Fill(hops.Get(0), 2);
+    Fill(hops.Get(1), 1);
+    NS_TEST_ASSERT_MSG_EQ(m_switch->GetObject<SharedBuffer>()->GetOccupancy(),
+                          3u,
+                          "Packets were not charged to the shared buffer");
+
+    Ptr<Ipv4DrillRoutingProtocol> drill = CreateObject<Ipv4DrillRoutingProtocol>(16);
+    drill->SetIpv4(m_switch->GetObject<Ipv4>());
+    drill->SetNextHops(std::vector<Ptr<NetDevice>>(hops.Begin(), hops.End()));
+
+    Ipv4Header header;
+    header.SetSource(Ipv4Address("10.0.0.2"));
+    header.SetDestination(Ipv4Address("10.9.9.9"));
+
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(1),
+                          "QUEUE_PACKETS should pick the shorter queue");
+
+    // Threshold share: (2 + 1) / (2 * 97) on port 0 against (1 + 1) / (0.5 * 97)
+    drill->SetLoadMetric(Ipv4DrillRoutingProtocol::SHARED_BUFFER);
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(0),
+                          "SHARED_BUFFER should pick the port using less of its threshold");
+
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup new-module-tests
+ * Check that SHARED_BUFFER charges the routed packet as the device queue will
+ */
+class DrillSharedBufferBytesTestCase : public DrillTestCase
+{
+  public:
+    DrillSharedBufferBytesTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DrillSharedBufferBytesTestCase::DrillSharedBufferBytesTestCase()
+    : DrillTestCase("DRILL charges IP and PPP headers in a byte-sized buffer")
+{
+}
+
+void
+DrillSharedBufferBytesTestCase::DoRun()
+{
+    NetDeviceContainer hops = BuildSwitch({"100Mbps", "100Mbps"});
+    SharedBufferHelper sharedBufferHelper;
+    sharedBufferHelper.SetBufferAttribute("BufferSize", QueueSizeValue(QueueSize("10000B")));
+    sharedBufferHelper.Install(m_switch);
+
+    auto queue = [&hops](uint32_t i) {
+        return DynamicCast<SharedBufferQueue>(
+            DynamicCast<PointToPointNetDevice>(hops.Get(i))->GetQueue());
+    };
+    queue(0)->SetAttribute("Alpha", DoubleValue(1.0));
+    queue(1)->SetAttribute("Alpha", DoubleValue(2.0));
+    queue(1)->Enqueue(Create<Packet>(121));
+
+    Ptr<Ipv4DrillRoutingProtocol> drill = CreateObject<Ipv4DrillRoutingProtocol>(16);
+    drill->SetIpv4(m_switch->GetObject<Ipv4>());
+    drill->SetNextHops(std::vector<Ptr<NetDevice>>(hops.Begin(), hops.End()));
+    drill->SetLoadMetric(Ipv4DrillRoutingProtocol::SHARED_BUFFER);
+
+    Ipv4Header header;
+    header.SetSource(Ipv4Address("10.0.0.2"));
+    header.SetDestination(Ipv4Address("10.9.9.9"));
+
+    // With F = 10000 - 121 free bytes, port 0 scores b / F and port 1
+    // (121 + b) / 2F: port 1 wins only if the packet is charged b > 121
+    // bytes, i.e. 100 payload + 20 IP + 2 PPP rather than 120.
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(1),
+                          "The routed packet was not charged its PPP header");
+
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup new-module-tests
+ * Check engine dispatch, per-engine memory and reproducible engine seeding
+ */
+class DrillEngineTestCase : public DrillTestCase
+{
+  public:
+    DrillEngineTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Build a UDP payload starting with the given ports
+     * @param sport the source port
+     * @param dport the destination port
+     * @return the packet
+     */
+    static Ptr<Packet> Flow(uint16_t sport, uint16_t dport);
+};
+
+DrillEngineTestCase::DrillEngineTestCase()
+    : DrillTestCase("DRILL engines dispatch and keep private state")
+{
+}
+
+Ptr<Packet>
+DrillEngineTestCase::Flow(uint16_t sport, uint16_t dport)
+{
+    uint8_t ports[4] = {static_cast<uint8_t>(sport >> 8),
+                        static_cast<uint8_t>(sport),
+                        static_cast<uint8_t>(dport >> 8),
+                        static_cast<uint8_t>(dport)};
+    return Create<Packet>(ports, 4);
+}
+
+void
+DrillEngineTestCase::DoRun()
+{
+    NetDeviceContainer hops = BuildSwitch({"100Mbps", "100Mbps"});
+    Ptr<Ipv4> ipv4 = m_switch->GetObject<Ipv4>();
+    std::vector<Ptr<NetDevice>> nextHops(hops.Begin(), hops.End());
+
+    Ptr<Ipv4DrillRoutingProtocol> drill = CreateObject<Ipv4DrillRoutingProtocol>(1);
+    drill->SetIpv4(ipv4);
+    drill->SetNextHops(nextHops);
+
+    Ipv4Header header;
+    header.SetSource(Ipv4Address("10.0.0.2"));
+    header.SetDestination(Ipv4Address("10.9.9.9"));
+    header.SetProtocol(17);
+
+    // Flow hash: a 5-tuple sticks to one engine, and flows spread over all
+    drill->SetEngines(4, Ipv4DrillRoutingProtocol::FLOW_HASH);
+    uint32_t e = drill->SelectEngine(Flow(1000, 80), header, hops.Get(0));
+    NS_TEST_ASSERT_MSG_EQ(drill->SelectEngine(Flow(1000, 80), header, hops.Get(1)),
+                          e,
+                          "The same 5-tuple moved to another engine");
+    std::set<uint32_t> engines;
+    for (uint16_t sport = 1000; sport < 1064; ++sport)
+    {
+        engines.insert(drill->SelectEngine(Flow(sport, 80), header, hops.Get(0)));
+    }
+    NS_TEST_ASSERT_MSG_EQ(engines.size(), 4u, "Flow hash did not use every engine");
+
+    // Non-first fragments carry no ports, so only addresses and protocol count
+    Ipv4Header fragment = header;
+    fragment.SetFragmentOffset(8);
+    engines.clear();
+    for (uint16_t sport = 1000; sport < 1064; ++sport)
+    {
+        engines.insert(drill->SelectEngine(Flow(sport, 80), fragment, hops.Get(0)));
+    }
+    NS_TEST_ASSERT_MSG_EQ(engines.size(), 1u, "Fragment payload bytes were hashed as ports");
+
+    // Ingress port: interface index modulo the number of engines
+    drill->SetEngines(2, Ipv4DrillRoutingProtocol::INGRESS_PORT);
+    for (uint32_t i = 0; i < hops.GetN(); ++i)
+    {
+        uint32_t interface = ipv4->GetInterfaceForDevice(hops.Get(i));
+        NS_TEST_ASSERT_MSG_EQ(drill->SelectEngine(Flow(1000, 80), header, hops.Get(i)),
+                              interface % 2,
+                              "Wrong engine for ingress device " << i);
+    }
+
+    // A decision only updates the memory of the engine that made it
+    uint32_t a = drill->SelectEngine(Flow(1000, 80), header, hops.Get(0));
+    uint32_t b = 1 - a;
+    Route(drill, Flow(1000, 80), header, hops.Get(0));
+    NS_TEST_ASSERT_MSG_EQ(drill->GetEngineMemory(a).size(), 1u, "Engine A did not remember");
+    NS_TEST_ASSERT_MSG_EQ(drill->GetEngineMemory(b).empty(), true, "Engine B memory changed");
+    Route(drill, Flow(1000, 80), header, hops.Get(1));
+    NS_TEST_ASSERT_MSG_EQ(drill->GetEngineMemory(b).size(), 1u, "Engine B did not remember");
+    drill->SetEngines(2, Ipv4DrillRoutingProtocol::INGRESS_PORT);
+    NS_TEST_ASSERT_MSG_EQ(drill->GetEngineMemory(a).empty() && drill->GetEngineMemory(b).empty(),
+                          true,
+                          "SetEngines did not reset the memory");
+
+    // The same stream gives the same decisions; idle equal links make each
+    // pick the first sample
+    Ptr<Ipv4DrillRoutingProtocol> twin = CreateObject<Ipv4DrillRoutingProtocol>(1);
+    twin->SetIpv4(ipv4);
+    twin->SetNextHops(nextHops);
+    twin->SetEngines(2, Ipv4DrillRoutingProtocol::INGRESS_PORT);
+    drill->AssignStreams(7);
+    twin->AssignStreams(7);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        Ptr<NetDevice> idev = hops.Get(i % 2);
+        NS_TEST_ASSERT_MSG_EQ(Route(drill, Flow(1000, 80), header, idev),
+                              Route(twin, Flow(1000, 80), header, idev),
+                              "Engines with the same stream diverged at decision " << i);
+    }
+
+    Simulator::Destroy();
+}
+
+/**
+ * @ingroup new-module-tests
+ * Check that engines decide on a queue snapshot refreshed once per interval
+ */
+class DrillSnapshotTestCase : public DrillTestCase
+{
+  public:
+    DrillSnapshotTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+DrillSnapshotTestCase::DrillSnapshotTestCase()
+    : DrillTestCase("DRILL engines read stale queue snapshots")
+{
+}
+
+void
+DrillSnapshotTestCase::DoRun()
+{
+    NetDeviceContainer hops = BuildSwitch({"100Mbps", "100Mbps", "100Mbps"});
+
+    // A large d makes sure every link is sampled on every decision
+    Ptr<Ipv4DrillRoutingProtocol> drill = CreateObject<Ipv4DrillRoutingProtocol>(64);
+    drill->SetIpv4(m_switch->GetObject<Ipv4>());
+    drill->SetNextHops({hops.Get(0), hops.Get(1)});
+    drill->SetEngineSnapshotInterval(MilliSeconds(10));
+
+    Ipv4Header header;
+    header.SetSource(Ipv4Address("10.0.0.2"));
+    header.SetDestination(Ipv4Address("10.9.9.9"));
+
+    Fill(hops.Get(1), 1);
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(0),
+                          "The empty port should win the first decision");
+
+    // Within the interval the snapshot still shows port 0 as the shorter one
+    Fill(hops.Get(0), 5);
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(0),
+                          "A decision within the interval should read the old snapshot");
+
+    // Past the interval the snapshot is refreshed
+    Simulator::Schedule(MilliSeconds(20), []() {});
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(1),
+                          "A decision past the interval should read the new queue state");
+
+    // A different set of next-hops forces a fresh snapshot within the interval
+    Fill(hops.Get(1), 9);
+    drill->SetNextHops({hops.Get(0), hops.Get(1), hops.Get(2)});
+    NS_TEST_ASSERT_MSG_EQ(Route(drill, Create<Packet>(100), header, hops.Get(0)),
+                          hops.Get(2),
+                          "SetNextHops should invalidate the snapshot");
+
+    Simulator::Destroy();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -76,6 +739,14 @@ NewModuleTestSuite::NewModuleTestSuite()
 {
     // Duration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
     AddTestCase(new NewModuleTestCase1, TestCase::Duration::QUICK);
+    AddTestCase(new AliasTableTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new DrillRateWeightingTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new SharedBufferQueueTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new SharedBufferQueueBytesTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new DrillSharedBufferTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new DrillSharedBufferBytesTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new DrillEngineTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new DrillSnapshotTestCase, TestCase::Duration::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite